@@ -2,6 +2,17 @@
 #include <iomanip>
 #include <fstream>
 #include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 #define EI_NIDENT 16
 using namespace std;
 
@@ -60,6 +71,51 @@ typedef struct {
     Half    st_shndx;
 } Symbol;
 
+typedef struct {
+    const char *    name;
+    char    type;
+    unsigned short  rd, rs1, rs2;
+    unsigned short  funct3;
+    int32_t imm;
+    Addr    target;
+} Instruction;
+
+typedef struct {
+    string  name;
+    Word    instructions;
+    Word    branches;
+    Word    jumps;
+    Word    formats[11];
+    Word    loads[3];
+    Word    stores[3];
+    Word    reads[32];
+    Word    writes[32];
+    unordered_map<const char *, Word> mnemonics;
+} Stats;
+
+typedef struct {
+    string  name;
+    Word    begin;
+    Word    end;
+    string  text;
+} RangeCache;
+
+typedef struct {
+    bool    valid;
+    uint64_t    textHash;
+    uint64_t    symtabHash;
+    uint64_t    strtabHash;
+    Off     startOff;
+    string  name;
+    vector<Word>    words;
+    vector<Symbol>  symbolTable;
+    vector<char>    symbolStrings;
+    unordered_map<Word, string> symbolLabels;
+    unordered_map<Word, string> labels;
+    vector<RangeCache>  ranges;
+    string  symbols;
+} OutputCache;
+
 void readHeader(ifstream& inputFile, ElfHeader& header) {
     if (!inputFile.is_open()) {
         return throw exception();
@@ -222,229 +278,245 @@ void printSections(ElfHeader& header, char * stringBuffer, SectionHeader section
     }
 }
 
-void printProgram(ofstream& out, Word * wordBuffer, Word wordAmount, Off startOff, char * name, unordered_map<Word, string>& labels) {
-    if (!out.is_open()) {
-        return throw exception();
+bool decodeInstruction(Word word, Addr addr, Instruction& ins) {
+    if (((word & 0b11) != 0b11) || ((word & 0b11100) == 0b11100)) {
+        //  not 32-bit
+        return false;
     }
+    const char * instruction = "";
+    
+    unsigned short opcode = (word >> 2) & 0b11111;
+    unsigned short rd = -1, rs1 = -1, rs2 = -1;
+    unsigned short funct3 = (word >> 12) & 0b111, funct7 = word >> 25;
+    int32_t imm = 0;
+    char type = 0xff;
+    Addr target = 0;
 
-    string x[] = {
-        "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
-        "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
-        "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7", 
-        "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6",
-    };
-
-    // process labels   
-    int lCounter = 0;
-    for (Word i = 0; i < wordAmount; i++) {
-        Addr addr = startOff + 4*i;
-        Addr target;
-        Word word = wordBuffer[i];
-        if (((word >> 2) & 0b11111) == 0b11011) {
-            // J
+    switch (opcode) {
+        case 0b01101: 
+        case 0b00101: {
+            // parse U
+            type = 'U';
+            instruction = (opcode & 0b01000 ? "lui" : "auipc");
+            imm = (word >> 12) << 12;
+            rd = (word >> 7) & 0b11111;
+            break;
+        }
+        case 0b11011: {
+            type = 'J';
+            instruction = "jal";
             // w/ sign extension
             int imm20 = (((int32_t)word) >> 31) << 20;
             int imm12 = word & (0b11111'111 << 12);
             int imm11 = ((word >> 20) & 0b1) << 11;
             int imm1  = ((word << 1) >> 22) << 1;
-            target = (int32_t)addr + (imm1 | imm11 | imm12 | imm20);
-        } else if (((word >> 2) & 0b11111) == 0b11000) {
-            // B
+            imm = imm1 | imm11 | imm12 | imm20;
+            rd = (word >> 7) & 0b11111;
+            target = (int32_t)addr + imm;
+            break;
+        }
+        case 0b11001: {
+            type = 'j';
+            if (funct3 != 0b000) {
+                return false;
+            }
+            instruction = "jalr";
+            rd = (word >> 7) & 0b11111;
+            rs1 = (word >> 15) & 0b11111;
+            imm = ((int32_t)word) >> 20;
+            break;
+        }
+        case 0b11000: {
+            // branching
+            type = 'B';
+            switch (funct3) {
+                case 0b000: { instruction = "beq";  break; }
+                case 0b001: { instruction = "bne";  break; }
+                case 0b100: { instruction = "blt";  break; }
+                case 0b101: { instruction = "bge";  break; }
+                case 0b110: { instruction = "bltu"; break; }
+                case 0b111: { instruction = "bgeu"; break; }
+                default: return false;
+            }
+            rs1 = (word >> 15) & 0b11111;
+            rs2 = (word >> 20) & 0b11111;
             int imm12 = (((int32_t)word) >> 31) << 12;
             int imm11 = ((word >> 7) & 0b1) << 11;
             int imm5 = ((word << 1) >> 26) << 5;
             int imm1 = (word >> 7) & 0b11110;
-            target = (int32_t)addr + (imm1 | imm5 | imm11 | imm12);
-        } else continue;
-        if (labels.count(target) == 0) {
-            labels.insert({target, ("L"+to_string(lCounter++))});
-        }
-    }
-
-    out << name << endl;
-    for (Word i = 0; i < wordAmount; i++) {
-        Addr addr = startOff + 4*i;
-        if (labels.count(addr)) {
-            out << setfill('0') << setw(8) << right << hex << (addr) << " \t<" << labels[addr] << ">:" << endl << setfill(' ');
-        }
-        Word word = wordBuffer[i];
-        if (((word & 0b11) != 0b11) || ((word & 0b11100) == 0b11100)) {
-            //  not 32-bit
-            continue;
+            imm = imm1 | imm5 | imm11 | imm12;
+            target = (int32_t)addr + imm;
+            break;
         }
-        string instruction;
-        
-        unsigned short opcode = (word >> 2) & 0b11111;
-        unsigned short rd = -1, rs1 = -1, rs2 = -1;
-        unsigned short funct3 = (word >> 12) & 0b111, funct7 = word >> 25;
-        int32_t imm = 0;
-        char type = 0xff;
-        Addr target;
-
-        switch (opcode) {
-            case 0b01101: 
-            case 0b00101: {
-                // parse U
-                type = 'U';
-                instruction = (opcode & 0b01000 ? "lui" : "auipc");
-                imm = (word >> 12) << 12;
-                rd = (word >> 7) & 0b11111;
-                break;
-            }
-            case 0b11011: {
-                type = 'J';
-                instruction = "jal";
-                // w/ sign extension
-                int imm20 = (((int32_t)word) >> 31) << 20;
-                int imm12 = word & (0b11111'111 << 12);
-                int imm11 = ((word >> 20) & 0b1) << 11;
-                int imm1  = ((word << 1) >> 22) << 1;
-                imm = imm1 | imm11 | imm12 | imm20;
-                rd = (word >> 7) & 0b11111;
-                target = (int32_t)addr + imm;
-                break;
+        case 0b00000: {
+            // load
+            type = 'L';
+            rd = (word >> 7) & 0b11111;
+            rs1 = (word >> 15) & 0b11111;
+            imm = ((int32_t)word) >> 20;
+            switch (funct3) {
+                case 0b000: { instruction = "lb";  break; }
+                case 0b001: { instruction = "lh";  break; }
+                case 0b010: { instruction = "lw";  break; }
+                case 0b100: { instruction = "lbu"; break; }
+                case 0b101: { instruction = "lhu"; break; }
+                default: return false;
             }
-            case 0b11001: {
-                type = 'j';
-                if (funct3 != 0b000) {
-                    continue;
-                }
-                instruction = "jalr";
-                rd = (word >> 7) & 0b11111;
-                rs1 = (word >> 15) & 0b11111;
-                imm = ((int32_t)word) >> 20;
-                break;
+            break;
+        }
+        case 0b01000: {
+            // store
+            type = 'S';
+            rs1 = (word >> 15) & 0b11111;
+            rs2 = (word >> 20) & 0b11111;
+            imm = ((word >> 7) & 0b11111) | ((((int32_t)word) >> 25) << 5);
+            switch (funct3) {
+                case 0b000: { instruction = "sb"; break; }
+                case 0b001: { instruction = "sh"; break; }
+                case 0b010: { instruction = "sw"; break; }
+                default: return false;
             }
-            case 0b11000: {
-                // branching
-                type = 'B';
-                switch (funct3) {
-                    case 0b000: { instruction = "beq";  break; }
-                    case 0b001: { instruction = "bne";  break; }
-                    case 0b100: { instruction = "blt";  break; }
-                    case 0b101: { instruction = "bge";  break; }
-                    case 0b110: { instruction = "bltu"; break; }
-                    case 0b111: { instruction = "bgeu"; break; }
-                    default: continue;
+            break;
+        }
+        case 0b00100: {
+            type = 'I';
+            rd = (word >> 7) & 0b11111;
+            rs1 = (word >> 15) & 0b11111;
+            imm = ((int32_t)word) >> 20;
+            switch (funct3) {
+                case 0b000: { instruction = "addi"; break; }
+                case 0b001: { if (funct7 != 0b0000000) return false; instruction = "slli"; break; }
+                case 0b010: { instruction = "slti"; break; }
+                case 0b011: { instruction = "sltiu"; break; }
+                case 0b100: { instruction = "xori"; break; }
+                case 0b101: { 
+                    if (funct7 == 0b0000000) instruction = "srli";
+                    else if (funct7 == 0b0100000) instruction = "srai";
+                    else return false;
+                    break; 
                 }
-                rs1 = (word >> 15) & 0b11111;
-                rs2 = (word >> 20) & 0b11111;
-                int imm12 = (((int32_t)word) >> 31) << 12;
-                int imm11 = ((word >> 7) & 0b1) << 11;
-                int imm5 = ((word << 1) >> 26) << 5;
-                int imm1 = (word >> 7) & 0b11110;
-                imm = imm1 | imm5 | imm11 | imm12;
-                target = (int32_t)addr + imm;
-                break;
+                case 0b110: { instruction = "ori"; break; }
+                case 0b111: { instruction = "andi"; break; }
+                default: return false;
             }
-            case 0b00000: {
-                // load
-                type = 'L';
-                rd = (word >> 7) & 0b11111;
-                rs1 = (word >> 15) & 0b11111;
-                imm = ((int32_t)word) >> 20;
+            break;
+        }
+        case 0b01100: {
+            type = 'R';
+            rd = (word >> 7) & 0b11111;
+            rs1 = (word >> 15) & 0b11111;
+            rs2 = (word >> 20) & 0b11111;
+            if      (funct7 == 0b0000000)
                 switch (funct3) {
-                    case 0b000: { instruction = "lb";  break; }
-                    case 0b001: { instruction = "lh";  break; }
-                    case 0b010: { instruction = "lw";  break; }
-                    case 0b100: { instruction = "lbu"; break; }
-                    case 0b101: { instruction = "lhu"; break; }
-                    default: continue;
+                    case 0b000: { instruction = "add"; break; }
+                    case 0b001: { instruction = "sll"; break; }
+                    case 0b010: { instruction = "slt"; break; }
+                    case 0b011: { instruction = "sltu";break; }
+                    case 0b100: { instruction = "xor"; break; }
+                    case 0b101: { instruction = "srl"; break; }
+                    case 0b110: { instruction = "or"; break; }
+                    case 0b111: { instruction = "and";break; }
+                    default: return false;
                 }
-                break;
-            }
-            case 0b01000: {
-                // store
-                type = 'S';
-                rs1 = (word >> 15) & 0b11111;
-                rs2 = (word >> 20) & 0b11111;
-                imm = ((word >> 7) & 0b11111) | ((((int32_t)word) >> 25) << 5);
+            else if (funct7 == 0b0100000)
                 switch (funct3) {
-                    case 0b000: { instruction = "sb"; break; }
-                    case 0b001: { instruction = "sh"; break; }
-                    case 0b010: { instruction = "sw"; break; }
-                    default: continue;
+                    case 0b000: { instruction = "sub"; break; }
+                    case 0b101: { instruction = "sra"; break; }
+                    default: return false;
                 }
-                break;
-            }
-            case 0b00100: {
-                type = 'I';
-                rd = (word >> 7) & 0b11111;
-                rs1 = (word >> 15) & 0b11111;
-                imm = ((int32_t)word) >> 20;
+            else if (funct7 == 0b0000001)
                 switch (funct3) {
-                    case 0b000: { instruction = "addi"; break; }
-                    case 0b001: { if (funct7 != 0b0000000) continue; instruction = "slli"; break; }
-                    case 0b010: { instruction = "slti"; break; }
-                    case 0b011: { instruction = "sltiu"; break; }
-                    case 0b100: { instruction = "xori"; break; }
-                    case 0b101: { 
-                        if (funct7 == 0b0000000) instruction = "srli";
-                        else if (funct7 == 0b0100000) instruction = "srai";
-                        else continue;
-                        break; 
-                    }
-                    case 0b110: { instruction = "ori"; break; }
-                    case 0b111: { instruction = "andi"; break; }
-                    default: continue;
-                }
-                break;
-            }
-            case 0b01100: {
-                type = 'R';
-                rd = (word >> 7) & 0b11111;
-                rs1 = (word >> 15) & 0b11111;
-                rs2 = (word >> 20) & 0b11111;
-                if      (funct7 == 0b0000000)
-                    switch (funct3) {
-                        case 0b000: { instruction = "add"; break; }
-                        case 0b001: { instruction = "sll"; break; }
-                        case 0b010: { instruction = "slt"; break; }
-                        case 0b011: { instruction = "sltu";break; }
-                        case 0b100: { instruction = "xor"; break; }
-                        case 0b101: { instruction = "srl"; break; }
-                        case 0b110: { instruction = "or"; break; }
-                        case 0b111: { instruction = "and";break; }
-                        default: continue;
-                    }
-                else if (funct7 == 0b0100000)
-                    switch (funct3) {
-                        case 0b000: { instruction = "sub"; break; }
-                        case 0b101: { instruction = "sra"; break; }
-                        default: continue;
-                    }
-                else if (funct7 == 0b0000001)
-                    switch (funct3) {
-                        case 0b000: { instruction = "mul";   break; }
-                        case 0b001: { instruction = "mulh";  break; }
-                        case 0b010: { instruction = "mulhsu";break; }
-                        case 0b011: { instruction = "mulhu"; break; }
-                        case 0b100: { instruction = "div";   break; }
-                        case 0b101: { instruction = "divu";  break; }
-                        case 0b110: { instruction = "rem";   break; }
-                        case 0b111: { instruction = "remu";  break; }
-                        default: continue;
-                    }
-                else continue;
-                break;
-            }
-            case 0b00011: {
-                // fence ?
-                type = 'F';
-                instruction = "fence";
-                if (funct3 != 0b000) {
-                    continue;
+                    case 0b000: { instruction = "mul";   break; }
+                    case 0b001: { instruction = "mulh";  break; }
+                    case 0b010: { instruction = "mulhsu";break; }
+                    case 0b011: { instruction = "mulhu"; break; }
+                    case 0b100: { instruction = "div";   break; }
+                    case 0b101: { instruction = "divu";  break; }
+                    case 0b110: { instruction = "rem";   break; }
+                    case 0b111: { instruction = "remu";  break; }
+                    default: return false;
                 }
-                rs1 = (word << 4) >> 28;
-                rs2 = (word << 8) >> 28;
-                break;
-            }
-            case 0b11100: {
-                type = 'E';
-                instruction = (((word >> 20) & 0b1) ? "ebreak" : "ecall");
-                break;
+            else return false;
+            break;
+        }
+        case 0b00011: {
+            // fence ?
+            type = 'F';
+            instruction = "fence";
+            if (funct3 != 0b000) {
+                return false;
             }
+            rs1 = (word << 4) >> 28;
+            rs2 = (word << 8) >> 28;
+            break;
+        }
+        case 0b11100: {
+            type = 'E';
+            instruction = (((word >> 20) & 0b1) ? "ebreak" : "ecall");
+            break;
         }
+    }
+
+    ins = {instruction, type, rd, rs1, rs2, funct3, imm, target};
+    return true;
+}
+
+bool getBranchTarget(Word word, Addr addr, Addr& target) {
+    if (((word >> 2) & 0b11111) == 0b11011) {
+        // J
+        // w/ sign extension
+        int imm20 = (((int32_t)word) >> 31) << 20;
+        int imm12 = word & (0b11111'111 << 12);
+        int imm11 = ((word >> 20) & 0b1) << 11;
+        int imm1  = ((word << 1) >> 22) << 1;
+        target = (int32_t)addr + (imm1 | imm11 | imm12 | imm20);
+    } else if (((word >> 2) & 0b11111) == 0b11000) {
+        // B
+        int imm12 = (((int32_t)word) >> 31) << 12;
+        int imm11 = ((word >> 7) & 0b1) << 11;
+        int imm5 = ((word << 1) >> 26) << 5;
+        int imm1 = (word >> 7) & 0b11110;
+        target = (int32_t)addr + (imm1 | imm5 | imm11 | imm12);
+    } else return false;
+    return true;
+}
+
+void getBranchLabels(Word * wordBuffer, Word wordAmount, Off startOff, unordered_map<Word, string>& labels) {
+    int lCounter = 0;
+    for (Word i = 0; i < wordAmount; i++) {
+        Addr target;
+        if (!getBranchTarget(wordBuffer[i], startOff + 4*i, target)) {
+            continue;
+        }
+        if (labels.count(target) == 0) {
+            labels.insert({target, ("L"+to_string(lCounter++))});
+        }
+    }
+}
+
+void printInstructions(ostream& out, Word * wordBuffer, Word begin, Word end, Off startOff, unordered_map<Word, string>& labels) {
+    string x[] = {
+        "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+        "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+        "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7", 
+        "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6",
+    };
+
+    for (Word i = begin; i < end; i++) {
+        Addr addr = startOff + 4*i;
+        if (labels.count(addr)) {
+            out << setfill('0') << setw(8) << right << hex << (addr) << " \t<" << labels[addr] << ">:" << endl << setfill(' ');
+        }
+        Word word = wordBuffer[i];
+        Instruction ins;
+        if (!decodeInstruction(word, addr, ins)) {
+            continue;
+        }
+        const char * instruction = ins.name;
+        char type = ins.type;
+        unsigned short rd = ins.rd, rs1 = ins.rs1, rs2 = ins.rs2;
+        int32_t imm = ins.imm;
+        Addr target = ins.target;
 
         out << "   " << left << setw(5) << setfill('0') << hex << (addr) << ":\t" <<
         setw(8) << right << word << "\t\t\t\t" << left << setw(7) << setfill(' ') << instruction ;
@@ -476,9 +548,399 @@ void printProgram(ofstream& out, Word * wordBuffer, Word wordAmount, Off startOf
 
 }
 
-void printSymbols(ofstream& out, Symbol * symbolBuffer, Word symbolAmount, char * symbolStringBuffer) {
+void printProgram(ostream& out, Word * wordBuffer, Word wordAmount, Off startOff, char * name, unordered_map<Word, string>& labels) {
+    if (!out) {
+        return throw exception();
+    }
+    getBranchLabels(wordBuffer, wordAmount, startOff, labels);
+    out << name << endl;
+    printInstructions(out, wordBuffer, 0, wordAmount, startOff, labels);
+}
+
+vector<pair<Addr, string>> getSymbolRanges(Word wordAmount, Off startOff, char * name, unordered_map<Word, string>& labels) {
+    vector<pair<Addr, string>> ranges;
+    for (auto& label : labels) {
+        if (label.first >= startOff && label.first < startOff + 4*wordAmount) {
+            ranges.push_back(label);
+        }
+    }
+    sort(ranges.begin(), ranges.end());
+    if (ranges.empty() || ranges[0].first != startOff) {
+        ranges.insert(ranges.begin(), {startOff, string(name)});
+    }
+    return ranges;
+}
+
+uint64_t hashBytes(const void * data, size_t size, uint64_t hash = 0x9e3779b97f4a7c15) {
+    // multiply and xor-shift eight bytes at a time, so that every input bit reaches every bit of the hash
+    const unsigned char * bytes = (const unsigned char *)data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, bytes + i, 8);
+        hash = (hash ^ chunk) * 0xff51afd7ed558ccd;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0xff51afd7ed558ccd;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+uint64_t hashString(const string& str, uint64_t hash) {
+    return hashBytes(str.c_str(), str.size() + 1, hash);
+}
+
+bool sameRangeLabels(Word * wordBuffer, Word begin, Word end, Off startOff, unordered_map<Word, string>& labels, unordered_map<Word, string>& oldLabels) {
+    // the labels a range prints are the ones at its addresses and at its jump and branch targets
+    auto sameLabel = [&](Addr addr) {
+        auto label = labels.find(addr), oldLabel = oldLabels.find(addr);
+        if (label == labels.end() || oldLabel == oldLabels.end()) {
+            return label == labels.end() && oldLabel == oldLabels.end();
+        }
+        return label->second == oldLabel->second;
+    };
+    for (Word i = begin; i < end; i++) {
+        Addr addr = startOff + 4*i, target;
+        if (!sameLabel(addr) || (getBranchTarget(wordBuffer[i], addr, target) && !sameLabel(target))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void printRange(RangeCache& range, Word * wordBuffer, Off startOff, unordered_map<Word, string>& labels) {
+    ostringstream rangeOut;
+    printInstructions(rangeOut, wordBuffer, range.begin, range.end, startOff, labels);
+    range.text = rangeOut.str();
+}
+
+void updateProgramCache(OutputCache& cache, vector<Word>& wordBuffer, Off startOff, char * name, unordered_map<Word, string>& symbolLabels, Word& redone) {
+    Word wordAmount = wordBuffer.size();
+    bool sameLayout = cache.valid && cache.startOff == startOff && cache.name == name &&
+        cache.words.size() == wordAmount && cache.symbolLabels == symbolLabels;
+
+    // as long as no jump or branch changed, the labels stay the same
+    // and only the ranges with changed words have to be printed again
+    vector<Word> changed;
+    bool branchesChanged = !sameLayout;
+    for (Word i = 0; sameLayout && i < wordAmount; i++) {
+        if (wordBuffer[i] != cache.words[i]) {
+            Addr addr = startOff + 4*i, target;
+            changed.push_back(i);
+            if (getBranchTarget(wordBuffer[i], addr, target) || getBranchTarget(cache.words[i], addr, target)) {
+                branchesChanged = true;
+                break;
+            }
+        }
+    }
+
+    if (!branchesChanged) {
+        size_t lastRange = cache.ranges.size();
+        for (Word i : changed) {
+            size_t r = upper_bound(cache.ranges.begin(), cache.ranges.end(), i,
+                [](Word word, RangeCache& range) { return word < range.begin; }) - cache.ranges.begin() - 1;
+            if (r != lastRange) {
+                printRange(cache.ranges[r], wordBuffer.data(), startOff, cache.labels);
+                lastRange = r;
+                redone++;
+            }
+        }
+        cache.words.swap(wordBuffer);
+        return;
+    }
+
+    unordered_map<Word, string> labels = symbolLabels;
+    vector<pair<Addr, string>> ranges = getSymbolRanges(wordAmount, startOff, name, labels);
+    getBranchLabels(wordBuffer.data(), wordAmount, startOff, labels);
+    bool labelsChanged = labels != cache.labels;
+
+    // a range prints the same as long as its words and the labels it mentions stay the same
+    vector<RangeCache> rangesCache(ranges.size());
+    size_t old = 0;
+    for (size_t r = 0; r < ranges.size(); r++) {
+        RangeCache& range = rangesCache[r];
+        range.name = ranges[r].second;
+        range.begin = (ranges[r].first - startOff) / 4;
+        range.end = (r + 1 < ranges.size() ? (ranges[r + 1].first - startOff) / 4 : wordAmount);
+
+        while (old < cache.ranges.size() && cache.ranges[old].begin < range.begin) {
+            old++;
+        }
+        bool reuse = cache.valid && cache.startOff == startOff && old < cache.ranges.size() &&
+            cache.ranges[old].begin == range.begin && cache.ranges[old].end == range.end && cache.ranges[old].name == range.name &&
+            equal(wordBuffer.begin() + range.begin, wordBuffer.begin() + range.end, cache.words.begin() + range.begin);
+        if (reuse && labelsChanged) {
+            reuse = sameRangeLabels(wordBuffer.data(), range.begin, range.end, startOff, labels, cache.labels);
+        }
+
+        if (reuse) {
+            range.text.swap(cache.ranges[old].text);
+        } else {
+            printRange(range, wordBuffer.data(), startOff, labels);
+            redone++;
+        }
+    }
+
+    cache.startOff = startOff;
+    cache.name = name;
+    cache.symbolLabels = symbolLabels;
+    cache.labels.swap(labels);
+    cache.ranges.swap(rangesCache);
+    cache.words.swap(wordBuffer);
+}
+
+void printProgramCache(ostream& out, OutputCache& cache) {
+    if (!out) {
+        return throw exception();
+    }
+    out << cache.name << endl;
+    for (RangeCache& range : cache.ranges) {
+        out.write(range.text.data(), range.text.size());
+    }
+}
+
+void countInstruction(Stats& stats, Instruction& ins) {
+    static const char formats[] = "RILSBUJjFE";
+    int format = 0;
+    while (format < 10 && formats[format] != ins.type) {
+        format++;
+    }
+    stats.instructions++;
+    stats.formats[format]++;
+    stats.mnemonics[*ins.name ? ins.name : "unknown"]++;
+
+    switch (ins.type) {
+        case 'R': { stats.writes[ins.rd]++; stats.reads[ins.rs1]++; stats.reads[ins.rs2]++; break; }
+        case 'I': { stats.writes[ins.rd]++; stats.reads[ins.rs1]++; break; }
+        case 'L': { stats.writes[ins.rd]++; stats.reads[ins.rs1]++; stats.loads[ins.funct3 & 0b11]++; break; }
+        case 'S': { stats.reads[ins.rs1]++; stats.reads[ins.rs2]++; stats.stores[ins.funct3 & 0b11]++; break; }
+        case 'B': { stats.reads[ins.rs1]++; stats.reads[ins.rs2]++; stats.branches++; break; }
+        case 'U': { stats.writes[ins.rd]++; break; }
+        case 'J': { stats.writes[ins.rd]++; stats.jumps++; break; }
+        case 'j': { stats.writes[ins.rd]++; stats.reads[ins.rs1]++; stats.jumps++; break; }
+    }
+}
+
+void mergeStats(Stats& into, Stats& from) {
+    into.instructions += from.instructions;
+    into.branches += from.branches;
+    into.jumps += from.jumps;
+    for (int i = 0; i < 11; i++) into.formats[i] += from.formats[i];
+    for (int i = 0; i < 3; i++) into.loads[i] += from.loads[i];
+    for (int i = 0; i < 3; i++) into.stores[i] += from.stores[i];
+    for (int i = 0; i < 32; i++) into.reads[i] += from.reads[i];
+    for (int i = 0; i < 32; i++) into.writes[i] += from.writes[i];
+    for (auto& mnemonic : from.mnemonics) into.mnemonics[mnemonic.first] += mnemonic.second;
+}
+
+vector<Stats> collectStats(Word * wordBuffer, Word wordAmount, Off startOff, char * name, unordered_map<Word, string>& labels) {
+    vector<pair<Addr, string>> ranges = getSymbolRanges(wordAmount, startOff, name, labels);
+
+    // every thread decodes its own chunk into tables for the ranges that chunk overlaps,
+    // so only the ranges split between two chunks are merged more than once
+    Word threadAmount = max(1u, thread::hardware_concurrency());
+    threadAmount = max(1u, min(threadAmount, wordAmount / 4096));
+    Word chunk = (wordAmount + threadAmount - 1) / threadAmount;
+    vector<size_t> firstRange(threadAmount);
+    vector<vector<Stats>> tables(threadAmount);
+    for (Word t = 0; t < threadAmount; t++) {
+        Word begin = t * chunk, end = min(wordAmount, begin + chunk);
+        if (begin >= end) {
+            continue;
+        }
+        auto rangeOf = [&](Word i) {
+            return upper_bound(ranges.begin(), ranges.end(), startOff + 4*i,
+                [](Addr addr, const pair<Addr, string>& range) { return addr < range.first; }) - ranges.begin() - 1;
+        };
+        firstRange[t] = rangeOf(begin);
+        tables[t].resize(rangeOf(end - 1) - firstRange[t] + 1);
+    }
+
+    vector<thread> threads;
+    for (Word t = 0; t < threadAmount; t++) {
+        threads.emplace_back([&, t]() {
+            Word begin = t * chunk, end = min(wordAmount, begin + chunk);
+            size_t range = firstRange[t];
+            for (Word i = begin; i < end; i++) {
+                Addr addr = startOff + 4*i;
+                while (range + 1 < ranges.size() && ranges[range + 1].first <= addr) {
+                    range++;
+                }
+                Instruction ins;
+                if (decodeInstruction(wordBuffer[i], addr, ins)) {
+                    countInstruction(tables[t][range - firstRange[t]], ins);
+                }
+            }
+        });
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    vector<Stats> result(ranges.size());
+    for (size_t i = 0; i < ranges.size(); i++) {
+        result[i].name = ranges[i].second;
+    }
+    for (Word t = 0; t < threadAmount; t++) {
+        for (size_t i = 0; i < tables[t].size(); i++) {
+            mergeStats(result[firstRange[t] + i], tables[t][i]);
+        }
+    }
+    return result;
+}
+
+vector<pair<string, Word>> sortMnemonics(Stats& stats) {
+    // counts are kept by the decoder's string literals, equal names are summed here
+    unordered_map<string, Word> byName;
+    for (auto& mnemonic : stats.mnemonics) {
+        byName[mnemonic.first] += mnemonic.second;
+    }
+    vector<pair<string, Word>> mnemonics(byName.begin(), byName.end());
+    sort(mnemonics.begin(), mnemonics.end());
+    return mnemonics;
+}
+
+int utf8Length(const string& str, size_t i) {
+    // length of a valid UTF-8 sequence starting at i, or 0
+    unsigned char c = str[i];
+    int length = (c >= 0xc2 && c <= 0xdf ? 2 : c >= 0xe0 && c <= 0xef ? 3 : c >= 0xf0 && c <= 0xf4 ? 4 : 0);
+    if (length == 0 || i + length > str.size()) {
+        return 0;
+    }
+    unsigned char next = str[i + 1];
+    if ((c == 0xe0 && next < 0xa0) || (c == 0xed && next > 0x9f) ||
+        (c == 0xf0 && next < 0x90) || (c == 0xf4 && next > 0x8f)) {
+        return 0;
+    }
+    for (int j = 1; j < length; j++) {
+        if (((unsigned char)str[i + j] & 0xc0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+string escapeJson(const string& str) {
+    string result;
+    for (size_t i = 0; i < str.size(); i++) {
+        unsigned char c = str[i];
+        int length = (c >= 0x80 ? utf8Length(str, i) : 1);
+        if (c < 0x20 || length == 0) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+            continue;
+        }
+        if (c == '"' || c == '\\') result += '\\';
+        result.append(str, i, length);
+        i += length - 1;
+    }
+    return result;
+}
+
+void printStatsJson(ofstream& out, Stats& stats, string * formats, string * x) {
+    string widths[] = { "byte", "half", "word" };
+
+    out << "{\"name\": \"" << escapeJson(stats.name) << "\", " << dec <<
+    "\"instructions\": " << stats.instructions << ", " <<
+    "\"branches\": " << stats.branches << ", " <<
+    "\"jumps\": " << stats.jumps << ", " <<
+    "\"branch_density\": " << (stats.instructions ? (double)stats.branches / stats.instructions : 0.0) << ", ";
+
+    out << "\"formats\": {";
+    for (int i = 0; i < 11; i++) out << (i ? ", " : "") << '"' << formats[i] << "\": " << stats.formats[i];
+    out << "}, \"loads\": {";
+    for (int i = 0; i < 3; i++) out << (i ? ", " : "") << '"' << widths[i] << "\": " << stats.loads[i];
+    out << "}, \"stores\": {";
+    for (int i = 0; i < 3; i++) out << (i ? ", " : "") << '"' << widths[i] << "\": " << stats.stores[i];
+    out << "}, \"mnemonics\": {";
+    vector<pair<string, Word>> mnemonics = sortMnemonics(stats);
+    for (size_t i = 0; i < mnemonics.size(); i++) out << (i ? ", " : "") << '"' << mnemonics[i].first << "\": " << mnemonics[i].second;
+    out << "}, \"registers\": {";
+    for (int i = 0; i < 32; i++) out << (i ? ", " : "") << '"' << x[i] << "\": {\"reads\": " << stats.reads[i] << ", \"writes\": " << stats.writes[i] << '}';
+    out << "}}";
+}
+
+void printStats(ofstream& out, vector<Stats>& symbolStats, char * name, bool json) {
     if (!out.is_open()) {
         return throw exception();
+    }
+
+    string x[] = {
+        "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+        "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+        "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7", 
+        "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6",
+    };
+
+    string formats[] = {
+        "R", "I", "I(load)", "S", "B", "U", "J", "I(jalr)", 
+        "fence", "system", "unknown",
+    };
+
+    Stats total = {};
+    total.name = name;
+    for (Stats& stats : symbolStats) {
+        mergeStats(total, stats);
+    }
+    out << fixed << setprecision(3);
+
+    if (json) {
+        out << "{\"total\": ";
+        printStatsJson(out, total, formats, x);
+        out << ", \"symbols\": [";
+        for (size_t i = 0; i < symbolStats.size(); i++) {
+            out << (i ? ", " : "");
+            printStatsJson(out, symbolStats[i], formats, x);
+        }
+        out << "]}" << endl;
+        return;
+    }
+
+    out << name << endl << dec <<
+    "Instructions " << total.instructions << endl <<
+    "Branches     " << total.branches << " (density " << 
+    (total.instructions ? (double)total.branches / total.instructions : 0.0) << ')' << endl <<
+    "Jumps        " << total.jumps << endl <<
+    "Loads        byte " << total.loads[0] << ", half " << total.loads[1] << ", word " << total.loads[2] << endl <<
+    "Stores       byte " << total.stores[0] << ", half " << total.stores[1] << ", word " << total.stores[2] << endl;
+
+    out << endl << "Format     Count" << endl;
+    for (int i = 0; i < 11; i++) {
+        if (total.formats[i]) {
+            out << left << setw(10) << formats[i] << ' ' << right << setw(5) << total.formats[i] << endl;
+        }
+    }
+
+    out << endl << "Mnemonic   Count" << endl;
+    vector<pair<string, Word>> mnemonics = sortMnemonics(total);
+    stable_sort(mnemonics.begin(), mnemonics.end(),
+        [](const pair<string, Word>& a, const pair<string, Word>& b) { return a.second > b.second; });
+    for (auto& mnemonic : mnemonics) {
+        out << left << setw(10) << mnemonic.first << ' ' << right << setw(5) << mnemonic.second << endl;
+    }
+
+    out << endl << "Register   Reads Writes" << endl;
+    for (int i = 0; i < 32; i++) {
+        out << left << setw(10) << x[i] << ' ' << right << setw(5) << total.reads[i] << ' ' << setw(6) << total.writes[i] << endl;
+    }
+
+    out << endl << "Symbol                Instrs Branches Density  Jumps  Loads Stores" << endl;
+    for (Stats& stats : symbolStats) {
+        out << left << setw(20) << stats.name << ' ' << right << 
+        setw(7) << stats.instructions << ' ' << setw(8) << stats.branches << ' ' << 
+        setw(7) << (stats.instructions ? (double)stats.branches / stats.instructions : 0.0) << ' ' <<
+        setw(6) << stats.jumps << ' ' <<
+        setw(6) << (stats.loads[0] + stats.loads[1] + stats.loads[2]) << ' ' << 
+        setw(6) << (stats.stores[0] + stats.stores[1] + stats.stores[2]) << endl;
+    }
+}
+
+void printSymbols(ostream& out, Symbol * symbolBuffer, Word symbolAmount, char * symbolStringBuffer) {
+    if (!out) {
+        return throw exception();
     } 
     string types[] = {
         "NOTYPE", "OBJECT", "FUNC", "SECTION", "FILE", 
@@ -523,7 +985,7 @@ void printSymbols(ofstream& out, Symbol * symbolBuffer, Word symbolAmount, char
         setw(8) << (bind < 0x10 ? binds[bind] : "") << ' ' <<
         setw(8) << (vis  < 0x7  ? vises[vis]  : "") << ' ';
         int j = 0;
-        while (special_i[j] != symbolBuffer[i].st_shndx && j < 16) {
+        while (j < 16 && special_i[j] != symbolBuffer[i].st_shndx) {
             j++;
         }
         if (j == 16) {
@@ -535,14 +997,8 @@ void printSymbols(ofstream& out, Symbol * symbolBuffer, Word symbolAmount, char
     }
 }
 
-int main(int argc, char const *argv[])
-{
-    if (argc != 3) {
-        cerr << "Wrong ammount of arguments. Expected 2." << endl;
-        return 1;
-    }
-
-    ifstream inputFile(argv[1], ios::in | ios::binary);
+int disassemble(char const * inputName, char const * outputName, bool stats, bool json, OutputCache * cache) {
+    ifstream inputFile(inputName, ios::in | ios::binary);
     if (!inputFile) {
         cerr << "Could not read file." << endl;
         return 1;
@@ -554,24 +1010,43 @@ int main(int argc, char const *argv[])
         return 1;
     }
 
-    ProgramHeader * programHeader = new ProgramHeader[header.e_phnum];
-    SectionHeader * sectionHeader = new SectionHeader[header.e_shnum];
-    try { readProgramHeader(inputFile, header, programHeader);
-            readSectionHeader(inputFile, header, sectionHeader); } catch (...) {
+    vector<ProgramHeader> programHeader(header.e_phnum);
+    vector<SectionHeader> sectionHeader(header.e_shnum);
+    try { readProgramHeader(inputFile, header, programHeader.data());
+            readSectionHeader(inputFile, header, sectionHeader.data()); } catch (...) {
         cerr << "There was an error while reading headers." << endl;
         return 1;
     }
-    delete[] programHeader;
+    inputFile.seekg(0, ios_base::end);
+    uint64_t fileSize = inputFile.tellg();
+    if (!inputFile || header.e_shstrndx >= header.e_shnum) {
+        cerr << "There was an error while reading headers." << endl;
+        return 1;
+    }
+    for (SectionHeader& section : sectionHeader) {
+        // NOBITS sections take no space in the file
+        if (section.sh_type != 0x8 && (uint64_t)section.sh_offset + section.sh_size > fileSize) {
+            cerr << "There was an error while reading headers." << endl;
+            return 1;
+        }
+    }
 
+    // string tables get a terminating zero in case the file does not end them
     SectionHeader& namesSection = sectionHeader[header.e_shstrndx];
-    char * stringBuffer = new char[namesSection.sh_size];
-    try { getStringTable(inputFile, namesSection, stringBuffer); } catch (...) {
+    vector<char> stringBuffer(namesSection.sh_size + 1);
+    try { getStringTable(inputFile, namesSection, stringBuffer.data()); } catch (...) {
         cerr << "There was an error while reading header names." << endl;
         return 1;
     }
+    for (int i = 0; i < header.e_shnum; i++) {
+        if (!inputFile || sectionHeader[i].sh_name >= namesSection.sh_size) {
+            cerr << "There was an error while reading header names." << endl;
+            return 1;
+        }
+    }
 
 #ifdef NDEBUG
-    printSections(header, stringBuffer, sectionHeader);
+    printSections(header, stringBuffer.data(), sectionHeader.data());
 #endif
 
     // parse .strtab
@@ -583,17 +1058,17 @@ int main(int argc, char const *argv[])
 
     for (int i = 0; i < header.e_shnum; i++) {
         if (!foundText && sectionHeader[i].sh_type == 0x1 &&
-            string(stringBuffer+sectionHeader[i].sh_name) == ".text") {
+            string(stringBuffer.data()+sectionHeader[i].sh_name) == ".text") {
             text = sectionHeader[i];
             foundText = true;
         }
         if (!foundSymtab && sectionHeader[i].sh_type == 0x2 && 
-            string(stringBuffer+sectionHeader[i].sh_name) == ".symtab") {
+            string(stringBuffer.data()+sectionHeader[i].sh_name) == ".symtab") {
             symtab = sectionHeader[i];
             foundSymtab = true;
         }
         if (!foundStrtab && sectionHeader[i].sh_type == 0x3 &&
-            string(stringBuffer+sectionHeader[i].sh_name) == ".strtab") {
+            string(stringBuffer.data()+sectionHeader[i].sh_name) == ".strtab") {
             strtab = sectionHeader[i];
             foundStrtab = true;
         }
@@ -604,43 +1079,216 @@ int main(int argc, char const *argv[])
         return 1;
     }
 
-    char * symbolStringBuffer = new char[strtab.sh_size];
-    try { getStringTable(inputFile, strtab, symbolStringBuffer); } catch (...) {
+    vector<char> symbolStringBuffer(strtab.sh_size + 1);
+    try { getStringTable(inputFile, strtab, symbolStringBuffer.data()); } catch (...) {
+        cerr << "There was an error while reading header names." << endl;
+        return 1;
+    }
+    if (!inputFile) {
         cerr << "There was an error while reading header names." << endl;
         return 1;
     }
     
-    Symbol * symbols = new Symbol[symtab.sh_size / symtab.sh_entsize];
-    try { getSymbolTable(inputFile, symtab, symbols); } catch (...) {
+    if (symtab.sh_entsize != sizeof(Symbol)) {
         cerr << "There was an error while reading symbol table." << endl;
         return 1;
     }
+    // buffers are rounded up, since sh_size does not have to be a multiple of the entry size
+    vector<Symbol> symbols((symtab.sh_size + sizeof(Symbol) - 1) / sizeof(Symbol));
+    try { getSymbolTable(inputFile, symtab, symbols.data()); } catch (...) {
+        cerr << "There was an error while reading symbol table." << endl;
+        return 1;
+    }
+    symbols.resize(symtab.sh_size / sizeof(Symbol));
+    for (Symbol& symbol : symbols) {
+        if (!inputFile || symbol.st_name >= strtab.sh_size) {
+            cerr << "There was an error while reading symbol table." << endl;
+            return 1;
+        }
+    }
 
-    Word * wordBuffer = new Word[text.sh_size / sizeof(Word)];
-    try { getProgBits(inputFile, text, wordBuffer); } catch (...) {
+    vector<Word> wordBuffer((text.sh_size + sizeof(Word) - 1) / sizeof(Word));
+    try { getProgBits(inputFile, text, wordBuffer.data()); } catch (...) {
+        cerr << "There was an error while reading program instructions." << endl;
+        return 1;
+    }
+    wordBuffer.resize(text.sh_size / sizeof(Word));
+    if (!inputFile) {
         cerr << "There was an error while reading program instructions." << endl;
         return 1;
     }
     inputFile.close();
 
-    ofstream outputFile(argv[2]);
+    // in watch mode only the sections whose contents changed are looked at again
+    bool textChanged = true, symbolsChanged = true;
+    uint64_t textHash = 0, symtabHash = 0, strtabHash = 0;
+    if (cache) {
+        textHash = hashString(stringBuffer.data() + text.sh_name, hashBytes(&text.sh_addr, sizeof(Addr)));
+        textHash = hashBytes(wordBuffer.data(), wordBuffer.size() * sizeof(Word), textHash);
+        symtabHash = hashBytes(symbols.data(), symbols.size() * sizeof(Symbol));
+        strtabHash = hashBytes(symbolStringBuffer.data(), strtab.sh_size);
+        // equal hashes are only a hint, the contents are compared against the previous run as well
+        textChanged = !cache->valid || cache->textHash != textHash ||
+            cache->startOff != text.sh_addr || cache->name != stringBuffer.data() + text.sh_name || cache->words != wordBuffer;
+        symbolsChanged = !cache->valid || cache->symtabHash != symtabHash || cache->strtabHash != strtabHash ||
+            cache->symbolStrings != symbolStringBuffer || cache->symbolTable.size() != symbols.size() ||
+            (!symbols.empty() && memcmp(cache->symbolTable.data(), symbols.data(), symbols.size() * sizeof(Symbol)) != 0);
+        if (!textChanged && !symbolsChanged) {
+#ifdef NDEBUG
+            cout << "Nothing changed." << endl;
+#endif
+            return 0;
+        }
+    }
+
+    unordered_map<Word, string> labels;
+    if (stats || symbolsChanged) {
+        getLabels(symbols.data(), symbols.size(), labels, symbolStringBuffer.data());
+    } else {
+        labels = cache->symbolLabels;
+    }
+
+    // in watch mode the output is replaced in one go, so readers never see a half-written file
+    string outputPath = (cache ? string(outputName) + ".tmp" : string(outputName));
+    ofstream outputFile(outputPath);
     if (!outputFile) {
         cerr << "Could not open file for writing." << endl;
         return 1;
     }
 
-    unordered_map<Word, string> labels;
-    getLabels(symbols, symtab.sh_size / symtab.sh_entsize, labels, symbolStringBuffer);
-
-    printProgram(outputFile, wordBuffer, text.sh_size / sizeof(Word), text.sh_addr, stringBuffer + text.sh_name, labels);
-    outputFile << endl;
-    printSymbols(outputFile, symbols, symtab.sh_size / symtab.sh_entsize, symbolStringBuffer);
+    try {
+        if (stats) {
+            vector<Stats> symbolStats = collectStats(wordBuffer.data(), wordBuffer.size(), text.sh_addr, stringBuffer.data() + text.sh_name, labels);
+            printStats(outputFile, symbolStats, stringBuffer.data() + text.sh_name, json);
+        } else if (cache) {
+            Word redone = 0;
+            if (textChanged || labels != cache->symbolLabels) {
+                updateProgramCache(*cache, wordBuffer, text.sh_addr, stringBuffer.data() + text.sh_name, labels, redone);
+            }
+            if (symbolsChanged) {
+                ostringstream symbolsOut;
+                printSymbols(symbolsOut, symbols.data(), symbols.size(), symbolStringBuffer.data());
+                cache->symbols = symbolsOut.str();
+                redone++;
+            }
+            printProgramCache(outputFile, *cache);
+            outputFile << endl << cache->symbols;
+#ifdef NDEBUG
+            cout << "Updated " << dec << redone << " of " << cache->ranges.size() + 1 << " ranges." << endl;
+#endif
+        } else {
+            printProgram(outputFile, wordBuffer.data(), wordBuffer.size(), text.sh_addr, stringBuffer.data() + text.sh_name, labels);
+            outputFile << endl;
+            printSymbols(outputFile, symbols.data(), symbols.size(), symbolStringBuffer.data());
+        }
+    } catch (...) {
+        outputFile.setstate(ios::badbit);
+    }
     outputFile.close();
+    if (!outputFile) {
+        // never let a half-written file replace the last good output
+        cerr << "Could not write the output file." << endl;
+        if (cache) {
+            remove(outputPath.c_str());
+        }
+        return 1;
+    }
 
-    delete[] stringBuffer;
-    delete[] sectionHeader;
-    delete[] symbolStringBuffer;
-    delete[] symbols;
-    delete[] wordBuffer;
+    if (cache) {
+        if (rename(outputPath.c_str(), outputName) != 0) {
+            cerr << "Could not replace the output file." << endl;
+            remove(outputPath.c_str());
+            return 1;
+        }
+        cache->valid = true;
+        cache->textHash = textHash;
+        cache->symtabHash = symtabHash;
+        cache->strtabHash = strtabHash;
+        cache->symbolTable.swap(symbols);
+        cache->symbolStrings.swap(symbolStringBuffer);
+        if (stats) {
+            cache->startOff = text.sh_addr;
+            cache->name = stringBuffer.data() + text.sh_name;
+            cache->words.swap(wordBuffer);
+        }
+    }
     return 0;
 }
+
+#ifdef __linux__
+int watch(char const * inputName, char const * outputName, bool stats, bool json) {
+    // linkers usually replace the file instead of rewriting it, so watch the directory
+    string path(inputName);
+    size_t slash = path.rfind('/');
+    string directory = (slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash));
+    string fileName = (slash == string::npos ? path : path.substr(slash + 1));
+
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        cerr << "Could not watch the input file." << endl;
+        return 1;
+    }
+
+    OutputCache cache = {};
+    disassemble(inputName, outputName, stats, json, &cache);
+
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Could not watch the input file." << endl;
+            close(fd);
+            return 1;
+        }
+
+        bool changed = false;
+        for (char * ptr = buffer; ptr < buffer + length; ) {
+            inotify_event * event = (inotify_event *)ptr;
+            if (event->len && fileName == event->name) {
+                changed = true;
+            }
+            ptr += sizeof(inotify_event) + event->len;
+        }
+        if (changed) {
+            disassemble(inputName, outputName, stats, json, &cache);
+        }
+    }
+}
+#endif
+
+int main(int argc, char const *argv[])
+{
+    bool stats = false, json = false, watching = false;
+    while (argc > 1 && string(argv[1]).rfind("--", 0) == 0) {
+        string flag(argv[1]);
+        if (flag == "--stats" || flag == "--stats=json") {
+            stats = true;
+            json = flag == "--stats=json";
+        } else if (flag == "--watch") {
+            watching = true;
+        } else {
+            cerr << "Unknown option " << flag << '.' << endl;
+            return 1;
+        }
+        argc--;
+        argv++;
+    }
+
+    if (argc != 3) {
+        cerr << "Wrong ammount of arguments. Expected 2." << endl;
+        return 1;
+    }
+
+    if (watching) {
+#ifdef __linux__
+        return watch(argv[1], argv[2], stats, json);
+#else
+        cerr << "--watch is only supported on Linux." << endl;
+        return 1;
+#endif
+    }
+    return disassemble(argv[1], argv[2], stats, json, nullptr);
+}